@@ -0,0 +1,126 @@
+#ifndef _CHARTIO_H
+#define _CHARTIO_H
+
+#include "defs.h"
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <functional>
+
+// Binary chart format, written in a single pass over the chart:
+//   header  "EPCH" version
+//   symbol  'S' id type length bytes      (emitted just before the first record referencing it)
+//   word    'W' index edgeCount           (starts the next set of edges)
+//   edge    'E' edgeNumber head tailLength tail... dot start end historyLength history...
+//   end     'X'
+// Every integer is an unsigned LEB128 varint. Symbols are referenced by id and history by edge
+// number, so the parse forest can be rebuilt from the back-pointers without any extra records.
+
+class Edge;
+
+// Hands out ids to symbols in the order they're first seen. A chart's edges come grouped by rule, so the
+// ids of the last rule are kept around to save looking all its symbols up again.
+class SymbolTable
+{
+private:
+    std::map<Symbol, unsigned int> ids;
+    std::unique_ptr<Rule> lastRule;
+    std::vector<unsigned int> lastRuleIds;
+
+    unsigned int id(const Symbol &s);
+
+public:
+    // Every symbol given an id so far, indexed by id
+    std::vector<Symbol> symbols;
+
+    // Ids of the rule's head followed by those of its tail
+    const std::vector<unsigned int> &ruleIds(const Rule &rule);
+};
+
+// Receives a chart one set of edges at a time
+class ChartSink
+{
+public:
+    virtual ~ChartSink() {}
+
+    virtual void beginWord(const std::size_t index, const std::size_t edgeCount) = 0;
+    virtual void addEdge(const unsigned int edgeNumber, const Rule &rule, const std::size_t dot,
+                         const unsigned int start, const unsigned int end,
+                         const std::vector<std::shared_ptr<Edge>> &history) = 0;
+};
+
+// Streams a chart out without building any strings per edge
+class ChartWriter : public ChartSink
+{
+private:
+    std::ostream &out;
+    SymbolTable symbols;
+    // How many of the table's symbols we've written records for
+    std::size_t writtenSymbols;
+    // Edges left in the current word, so we notice if the caller's count was wrong
+    std::size_t remainingEdges;
+
+    void writeValue(std::size_t value);
+
+public:
+    ChartWriter(std::ostream &out);
+
+    void beginWord(const std::size_t index, const std::size_t edgeCount) override;
+    void addEdge(const unsigned int edgeNumber, const Rule &rule, const std::size_t dot,
+                 const unsigned int start, const unsigned int end,
+                 const std::vector<std::shared_ptr<Edge>> &history) override;
+    void finish();
+};
+
+// An edge read back from a serialised chart
+class ChartEdge
+{
+public:
+    unsigned int edgeNumber;
+    unsigned int head;
+    std::vector<unsigned int> tail;
+    unsigned int dot;
+    unsigned int start;
+    unsigned int end;
+    std::vector<unsigned int> history;
+};
+
+class Chart
+{
+public:
+    std::vector<Symbol> symbols;
+    std::vector<std::vector<ChartEdge>> words;
+};
+
+// Builds a chart in memory, for when we don't need the serialised form
+class ChartBuilder : public ChartSink
+{
+private:
+    Chart &chart;
+    SymbolTable symbols;
+
+public:
+    ChartBuilder(Chart &chart);
+
+    void beginWord(const std::size_t index, const std::size_t edgeCount) override;
+    void addEdge(const unsigned int edgeNumber, const Rule &rule, const std::size_t dot,
+                 const unsigned int start, const unsigned int end,
+                 const std::vector<std::shared_ptr<Edge>> &history) override;
+};
+
+// Returns false if the input is malformed or truncated
+bool readChart(std::istream &in, Chart &chart);
+
+// Prints the chart as a table, one set of edges per word, optionally only including some edges
+void renderChart(std::ostream &out, const Chart &chart,
+                 const std::function<bool(const ChartEdge &)> &filter = [](const ChartEdge &) { return true; });
+
+// Prints the edges only present in one of the charts, or present a different number of times. Edges are
+// compared by rule, progress, span and the rule and span of each edge in their history, not by edge number.
+// Returns the number of differing edges.
+unsigned int diffCharts(std::ostream &out, const Chart &before, const Chart &after);
+
+#endif
@@ -22,7 +22,7 @@ public:
     bool isTerminal() const;
     bool isNonterminal() const;
 
-    std::string getValue() const;
+    const std::string &getValue() const;
 
     bool operator ==(const Symbol &rhs) const;
     bool operator !=(const Symbol &rhs) const;
@@ -10,6 +10,24 @@
 #include <map>
 #include <ostream>
 
+class ChartSink;
+
+// What a recovering parse found out about the sentence
+class ParseDiagnostics
+{
+public:
+    // Number of words consumed before the parse first got stuck, the sentence length if it never did
+    unsigned int furthestPosition = 0;
+    // Symbols that edges at the furthest position were waiting for
+    std::set<Symbol> expectedSymbols;
+
+    // Completed constituents, left to right, covering the sentence in as few fragments as possible (each
+    // uncovered word counting as a fragment), then leaving as few words uncovered as possible
+    std::vector<std::shared_ptr<Edge>> cover;
+    // Positions of words that aren't part of any constituent in the cover
+    std::vector<unsigned int> uncoveredWords;
+};
+
 class Parser
 {
 private:
@@ -27,6 +45,18 @@ private:
     void scan(const std::vector<std::string>::const_iterator currentWord);
     void complete();
 
+    unsigned int parse(const std::vector<std::string> &words, ParseDiagnostics *diagnostics);
+    void seed(const unsigned int position);
+    void recover(const std::vector<std::string>::const_iterator currentWord);
+    void findExpected(const std::set<std::shared_ptr<Edge>, EdgePointerComparator> &gen,
+                      std::set<Symbol> &expected) const;
+    void findCover(const std::size_t wordCount, ParseDiagnostics &diagnostics) const;
+
+    // Feeds every set of edges to the sink, in order
+    void writeChart(ChartSink &sink) const;
+
+    static std::vector<std::string> tokenise(const std::string &sentence);
+
     std::map<Symbol, std::vector<Rule>> makeRuleMapping(const std::vector<Rule> &rules) const;
 
 public:
@@ -36,6 +66,16 @@ public:
     unsigned int parse(const std::string &sentence);
     unsigned int parse(const std::vector<std::string> &words);
 
+    // Recovery mode: rather than giving up on the first word that can't be parsed, restart the parse there
+    // (skipping the word if nothing can begin with it) so the rest of the chart is still filled in.
+    // Still a single pass over the sentence, with at most two extra sets of predictions per failed word
+    // (one to restart at the word, one to restart after it if it has to be skipped).
+    unsigned int parse(const std::string &sentence, ParseDiagnostics &diagnostics);
+    unsigned int parse(const std::vector<std::string> &words, ParseDiagnostics &diagnostics);
+
+    // Cheap enough to leave on in production, see chartio.h for the format
+    void writeChart(std::ostream &out) const;
+
     void printChart() const;
     void printChart(std::ostream &out) const;
 };
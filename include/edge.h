@@ -5,19 +5,6 @@
 
 #include <vector>
 #include <memory>
-#include <ostream>
-
-// An edge "pretty-printed"
-class EdgeString
-{
-public:
-    std::string edgeNumber;
-    std::string ruleProgress;
-    std::string span;
-    std::string history;
-
-    friend std::ostream &operator <<(std::ostream &out, const EdgeString &e);
-};
 
 class Edge
 {
@@ -38,6 +25,9 @@ public:
     std::shared_ptr<Edge> copy(const unsigned int edgeNumber) const;
 
     Symbol getHead() const;
+    const Rule &getRule() const;
+    // How many symbols of the rule's tail have been matched
+    std::size_t getDot() const;
 
     bool completed() const;
     Symbol nextSymbol() const;
@@ -48,8 +38,7 @@ public:
     unsigned int getEnd() const;
 
     unsigned int getEdgeNumber() const;
-
-    EdgeString print() const;
+    const std::vector<std::shared_ptr<Edge>> &getHistory() const;
 
     bool operator  <(const Edge &rhs) const;
     bool operator ==(const Edge &rhs) const;
@@ -0,0 +1,515 @@
+#include "chartio.h"
+#include "edge.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <string>
+
+static const char chartMagic[] = { 'E', 'P', 'C', 'H' };
+static const std::size_t chartVersion = 1;
+
+unsigned int SymbolTable::id(const Symbol &s)
+{
+    const auto existing = ids.find(s);
+    if (existing != ids.end())
+        return existing->second;
+
+    const unsigned int id = symbols.size();
+    ids.emplace(s, id);
+    symbols.push_back(s);
+    return id;
+}
+const std::vector<unsigned int> &SymbolTable::ruleIds(const Rule &rule)
+{
+    if (lastRule && *lastRule == rule)
+        return lastRuleIds;
+
+    lastRuleIds.clear();
+    lastRuleIds.push_back(id(rule.head));
+    for (const auto &s : rule.tail)
+        lastRuleIds.push_back(id(s));
+
+    lastRule.reset(new Rule(rule));
+    return lastRuleIds;
+}
+
+
+ChartWriter::ChartWriter(std::ostream &out)
+    : out(out), writtenSymbols(0), remainingEdges(0)
+{
+    out.write(chartMagic, sizeof(chartMagic));
+    writeValue(chartVersion);
+}
+
+void ChartWriter::beginWord(const std::size_t index, const std::size_t edgeCount)
+{
+    assert(remainingEdges == 0);
+    remainingEdges = edgeCount;
+
+    out.put('W');
+    writeValue(index);
+    writeValue(edgeCount);
+}
+void ChartWriter::addEdge(const unsigned int edgeNumber, const Rule &rule, const std::size_t dot,
+                          const unsigned int start, const unsigned int end,
+                          const std::vector<std::shared_ptr<Edge>> &history)
+{
+    assert(remainingEdges > 0);
+    --remainingEdges;
+
+    const auto &ids = symbols.ruleIds(rule);
+
+    // Symbol records have to come before the edge record that refers to them
+    for (; writtenSymbols < symbols.symbols.size(); ++writtenSymbols)
+    {
+        const Symbol &s = symbols.symbols[writtenSymbols];
+        const std::string &value = s.getValue();
+        out.put('S');
+        writeValue(writtenSymbols);
+        writeValue(s.isTerminal() ? SymbolType::Terminal : SymbolType::Nonterminal);
+        writeValue(value.size());
+        out.write(value.data(), value.size());
+    }
+
+    out.put('E');
+    writeValue(edgeNumber);
+    writeValue(ids.front());
+    writeValue(ids.size() - 1);
+    for (auto id = ids.begin() + 1; id != ids.end(); ++id)
+        writeValue(*id);
+
+    writeValue(dot);
+    writeValue(start);
+    writeValue(end);
+
+    writeValue(history.size());
+    for (const auto &h : history)
+        writeValue(h->getEdgeNumber());
+}
+void ChartWriter::finish()
+{
+    assert(remainingEdges == 0);
+
+    out.put('X');
+    out.flush();
+}
+
+void ChartWriter::writeValue(std::size_t value)
+{
+    // Low 7 bits per byte, top bit set if there are more bytes to come
+    while (value >= 0x80)
+    {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+
+ChartBuilder::ChartBuilder(Chart &chart)
+    : chart(chart)
+{
+    chart.symbols.clear();
+    chart.words.clear();
+}
+
+void ChartBuilder::beginWord(const std::size_t index, const std::size_t edgeCount)
+{
+    assert(index == chart.words.size());
+
+    chart.words.push_back({});
+    chart.words.back().reserve(edgeCount);
+}
+void ChartBuilder::addEdge(const unsigned int edgeNumber, const Rule &rule, const std::size_t dot,
+                           const unsigned int start, const unsigned int end,
+                           const std::vector<std::shared_ptr<Edge>> &history)
+{
+    assert(!chart.words.empty());
+
+    const auto &ids = symbols.ruleIds(rule);
+    for (std::size_t i = chart.symbols.size(); i < symbols.symbols.size(); ++i)
+        chart.symbols.push_back(symbols.symbols[i]);
+
+    chart.words.back().emplace_back();
+    ChartEdge &e = chart.words.back().back();
+    e.edgeNumber = edgeNumber;
+    e.head = ids.front();
+    e.tail.assign(ids.begin() + 1, ids.end());
+    e.dot = dot;
+    e.start = start;
+    e.end = end;
+    e.history.reserve(history.size());
+    for (const auto &h : history)
+        e.history.push_back(h->getEdgeNumber());
+}
+
+
+static bool readValue(std::istream &in, std::size_t &value)
+{
+    value = 0;
+    for (unsigned int shift = 0; shift < 8 * sizeof(value); shift += 7)
+    {
+        const int c = in.get();
+        if (c == std::istream::traits_type::eof())
+            return false;
+
+        value |= static_cast<std::size_t>(c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false; // Too many continuation bytes
+}
+static bool readValue(std::istream &in, unsigned int &value)
+{
+    std::size_t v;
+    if (!readValue(in, v) || v > std::numeric_limits<unsigned int>::max())
+        return false;
+
+    value = static_cast<unsigned int>(v);
+    return true;
+}
+
+static bool readSymbol(std::istream &in, Chart &chart)
+{
+    unsigned int id, type;
+    std::size_t length;
+    if (!readValue(in, id) || !readValue(in, type) || !readValue(in, length))
+        return false;
+
+    // Ids are handed out in order, so each new symbol must be the next one
+    if (id != chart.symbols.size() || (type != SymbolType::Terminal && type != SymbolType::Nonterminal))
+        return false;
+
+    // Read in chunks so a corrupt length fails at the end of the input rather than in one huge allocation
+    std::string value;
+    char buffer[256];
+    while (value.size() < length)
+    {
+        const std::size_t chunk = std::min(sizeof(buffer), length - value.size());
+        if (!in.read(buffer, chunk))
+            return false;
+        value.append(buffer, chunk);
+    }
+
+    chart.symbols.emplace_back(value, static_cast<SymbolType>(type));
+    return true;
+}
+static bool readEdge(std::istream &in, Chart &chart)
+{
+    ChartEdge e;
+    unsigned int tailLength, historyLength;
+    if (!readValue(in, e.edgeNumber) || !readValue(in, e.head) || !readValue(in, tailLength))
+        return false;
+
+    for (unsigned int i = 0; i < tailLength; ++i)
+    {
+        unsigned int symbol;
+        if (!readValue(in, symbol) || symbol >= chart.symbols.size())
+            return false;
+        e.tail.push_back(symbol);
+    }
+
+    if (!readValue(in, e.dot) || !readValue(in, e.start) || !readValue(in, e.end) || !readValue(in, historyLength))
+        return false;
+
+    for (unsigned int i = 0; i < historyLength; ++i)
+    {
+        unsigned int edgeNumber;
+        if (!readValue(in, edgeNumber))
+            return false;
+        e.history.push_back(edgeNumber);
+    }
+
+    if (e.head >= chart.symbols.size() || e.dot > e.tail.size() || e.start > e.end)
+        return false;
+
+    chart.words.back().push_back(std::move(e));
+    return true;
+}
+
+bool readChart(std::istream &in, Chart &chart)
+{
+    chart.symbols.clear();
+    chart.words.clear();
+
+    char magic[sizeof(chartMagic)];
+    std::size_t version;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), chartMagic))
+        return false;
+    if (!readValue(in, version) || version != chartVersion)
+        return false;
+
+    // Number of edges the current word said it would have
+    std::size_t edgeCount = 0;
+    while (true)
+    {
+        const int tag = in.get();
+
+        // A word is finished by the next word or the end of the chart, so check we got all its edges
+        if ((tag == 'W' || tag == 'X') && !chart.words.empty() && chart.words.back().size() != edgeCount)
+            return false;
+
+        if (tag == 'S')
+        {
+            if (!readSymbol(in, chart))
+                return false;
+        }
+        else if (tag == 'W')
+        {
+            std::size_t index;
+            if (!readValue(in, index) || !readValue(in, edgeCount) || index != chart.words.size())
+                return false;
+            chart.words.push_back({});
+        }
+        else if (tag == 'E')
+        {
+            // Edges have to belong to a word, and can't overflow it
+            if (chart.words.empty() || chart.words.back().size() == edgeCount || !readEdge(in, chart))
+                return false;
+        }
+        else if (tag == 'X')
+            return true;
+        else // Unknown record or the chart was truncated
+            return false;
+    }
+}
+
+
+static std::string ruleProgressString(const Chart &chart, const ChartEdge &e)
+{
+    std::string out = chart.symbols[e.head].getValue() + " ->";
+    // Output the tail symbols with a dot before the current symbol
+    for (std::size_t i = 0; i < e.tail.size(); ++i)
+    {
+        if (e.dot == i)
+            out += " .";
+        out += " " + chart.symbols[e.tail[i]].getValue();
+    }
+    if (e.dot == e.tail.size())
+        out += " .";
+    return out;
+}
+static std::string spanString(const ChartEdge &e)
+{
+    return "(" + std::to_string(e.start) + "," + std::to_string(e.end) + ")";
+}
+
+// Each line of the table is assembled in one reused buffer, so work out how wide each field will be
+// without building it
+static std::size_t digits(unsigned int value)
+{
+    std::size_t count = 1;
+    while (value >= 10)
+    {
+        value /= 10;
+        ++count;
+    }
+    return count;
+}
+static std::size_t ruleProgressWidth(const Chart &chart, const ChartEdge &e)
+{
+    std::size_t width = chart.symbols[e.head].getValue().size() + 3; // "H ->"
+    for (const auto s : e.tail)
+        width += 1 + chart.symbols[s].getValue().size(); // " S"
+    return width + 2; // " ."
+}
+static std::size_t historyWidth(const ChartEdge &e)
+{
+    if (e.history.empty())
+        return 0;
+
+    std::size_t width = 1; // "("
+    for (const auto h : e.history)
+        width += 2 + digits(h); // "eN," or "eN)"
+    return width;
+}
+
+static void appendNumber(std::string &line, unsigned int value)
+{
+    char buffer[16];
+    char *first = buffer + sizeof(buffer);
+    do
+    {
+        *--first = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    line.append(first, buffer + sizeof(buffer));
+}
+
+void renderChart(std::ostream &out, const Chart &chart, const std::function<bool(const ChartEdge &)> &filter)
+{
+    // An edge in the table along with the widths of its fields
+    class Row
+    {
+    public:
+        const ChartEdge *edge;
+        std::size_t edgeNumberWidth, ruleWidth, spanWidth, historyWidth;
+    };
+
+    std::vector<std::vector<Row>> table;
+    std::size_t edgeNumberColumn = 0, ruleColumn = 0, spanColumn = 0, historyColumn = 0;
+
+    for (const auto &word : chart.words)
+    {
+        table.push_back({});
+        auto &rows = table.back();
+
+        for (const auto &e : word)
+        {
+            if (!filter(e))
+                continue;
+
+            const Row row { &e, 1 + digits(e.edgeNumber), ruleProgressWidth(chart, e),
+                            3 + digits(e.start) + digits(e.end), historyWidth(e) };
+            rows.push_back(row);
+
+            edgeNumberColumn = std::max(edgeNumberColumn, row.edgeNumberWidth);
+            ruleColumn = std::max(ruleColumn, row.ruleWidth);
+            spanColumn = std::max(spanColumn, row.spanWidth);
+            historyColumn = std::max(historyColumn, row.historyWidth);
+        }
+
+        // Sort the edges by edgeNumber
+        std::sort(rows.begin(), rows.end(),
+            [](const Row &r1, const Row &r2) { return r1.edge->edgeNumber < r2.edge->edgeNumber; });
+    }
+
+    unsigned int wordCount = 0;
+    const std::string spacing = "    ";
+    std::string line;
+
+    for (const auto &word : table)
+    {
+        line = "Word ";
+        appendNumber(line, wordCount++);
+        line += '\n';
+        out.write(line.data(), line.size());
+
+        for (const auto &row : word)
+        {
+            const ChartEdge &e = *row.edge;
+            line.clear();
+
+            line += 'e';
+            appendNumber(line, e.edgeNumber);
+            line.append(edgeNumberColumn - row.edgeNumberWidth, ' ');
+            line += spacing;
+
+            line += chart.symbols[e.head].getValue();
+            line += " ->";
+            // Output the tail symbols with a dot before the current symbol
+            for (std::size_t i = 0; i < e.tail.size(); ++i)
+            {
+                if (e.dot == i)
+                    line += " .";
+                line += ' ';
+                line += chart.symbols[e.tail[i]].getValue();
+            }
+            if (e.dot == e.tail.size())
+                line += " .";
+            line.append(ruleColumn - row.ruleWidth, ' ');
+            line += spacing;
+
+            line += '(';
+            appendNumber(line, e.start);
+            line += ',';
+            appendNumber(line, e.end);
+            line += ')';
+            line.append(spanColumn - row.spanWidth, ' ');
+            line += spacing;
+
+            for (std::size_t i = 0; i < e.history.size(); ++i)
+            {
+                line += i == 0 ? "(e" : ",e";
+                appendNumber(line, e.history[i]);
+            }
+            if (!e.history.empty())
+                line += ')';
+            line.append(historyColumn - row.historyWidth, ' ');
+            line += '\n';
+
+            out.write(line.data(), line.size());
+        }
+    }
+}
+
+// Edge numbers depend on the order edges were found in, so describe an edge by what it covers and how it was
+// derived, ie. the rule and span of each edge in its history
+static std::string derivationString(const Chart &chart, const std::map<unsigned int, const ChartEdge *> &byNumber,
+                                    const ChartEdge &e)
+{
+    std::string out = ruleProgressString(chart, e) + "    " + spanString(e);
+    if (e.history.empty())
+        return out;
+
+    out += "    [";
+    for (std::size_t i = 0; i < e.history.size(); ++i)
+    {
+        if (i > 0)
+            out += ", ";
+
+        const auto child = byNumber.find(e.history[i]);
+        if (child == byNumber.end()) // History refers to an edge that isn't in the chart
+            out += "?";
+        else
+            out += ruleProgressString(chart, *child->second) + " " + spanString(*child->second);
+    }
+    return out + "]";
+}
+static std::map<unsigned int, const ChartEdge *> edgesByNumber(const Chart &chart)
+{
+    std::map<unsigned int, const ChartEdge *> byNumber;
+    for (const auto &word : chart.words)
+    {
+        for (const auto &e : word)
+            byNumber.emplace(e.edgeNumber, &e);
+    }
+    return byNumber;
+}
+
+unsigned int diffCharts(std::ostream &out, const Chart &before, const Chart &after)
+{
+    unsigned int differences = 0;
+
+    const auto beforeByNumber = edgesByNumber(before);
+    const auto afterByNumber = edgesByNumber(after);
+
+    const std::size_t wordCount = std::max(before.words.size(), after.words.size());
+    for (std::size_t i = 0; i < wordCount; ++i)
+    {
+        // Multisets so that the same edge derived a different number of times (ie. ambiguity) shows up
+        std::multiset<std::string> beforeEdges, afterEdges;
+        if (i < before.words.size())
+        {
+            for (const auto &e : before.words[i])
+                beforeEdges.insert(derivationString(before, beforeByNumber, e));
+        }
+        if (i < after.words.size())
+        {
+            for (const auto &e : after.words[i])
+                afterEdges.insert(derivationString(after, afterByNumber, e));
+        }
+
+        std::vector<std::string> removed, added;
+        std::set_difference(beforeEdges.begin(), beforeEdges.end(), afterEdges.begin(), afterEdges.end(),
+                            std::back_inserter(removed));
+        std::set_difference(afterEdges.begin(), afterEdges.end(), beforeEdges.begin(), beforeEdges.end(),
+                            std::back_inserter(added));
+
+        if (removed.empty() && added.empty())
+            continue;
+
+        out << "Word " << i << std::endl;
+        for (const auto &e : removed)
+            out << "- " << e << std::endl;
+        for (const auto &e : added)
+            out << "+ " << e << std::endl;
+
+        differences += removed.size() + added.size();
+    }
+
+    return differences;
+}
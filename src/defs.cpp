@@ -12,7 +12,7 @@ bool Symbol::isNonterminal() const
 {
     return symbolType == SymbolType::Nonterminal;
 }
-std::string Symbol::getValue() const
+const std::string &Symbol::getValue() const
 {
     return value;
 }
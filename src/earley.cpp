@@ -1,9 +1,9 @@
 #include "earley.h"
+#include "chartio.h"
 
 #include <assert.h>
 #include <algorithm>
 #include <iostream>
-#include <iomanip>
 #include <sstream>
 #include <queue>
 
@@ -24,7 +24,7 @@ std::map<Symbol, std::vector<Rule>> Parser::makeRuleMapping(const std::vector<Ru
     return mapping;
 }
 
-unsigned int Parser::parse(const std::string &sentence)
+std::vector<std::string> Parser::tokenise(const std::string &sentence)
 {
     std::vector<std::string> tokens;
     std::stringstream ss(sentence);
@@ -33,9 +33,26 @@ unsigned int Parser::parse(const std::string &sentence)
     while (ss >> tok)
         tokens.push_back(tok);
 
-    return parse(tokens);
+    return tokens;
+}
+
+unsigned int Parser::parse(const std::string &sentence)
+{
+    return parse(tokenise(sentence));
 }
 unsigned int Parser::parse(const std::vector<std::string> &words)
+{
+    return parse(words, nullptr);
+}
+unsigned int Parser::parse(const std::string &sentence, ParseDiagnostics &diagnostics)
+{
+    return parse(tokenise(sentence), diagnostics);
+}
+unsigned int Parser::parse(const std::vector<std::string> &words, ParseDiagnostics &diagnostics)
+{
+    return parse(words, &diagnostics);
+}
+unsigned int Parser::parse(const std::vector<std::string> &words, ParseDiagnostics *diagnostics)
 {
     // Initialise the new edge chart
     const auto startRule = rules.at(startSymbol).front();
@@ -44,6 +61,15 @@ unsigned int Parser::parse(const std::vector<std::string> &words)
     edges.clear();
     edges.push_back({ std::make_shared<Edge>(nextEdgeNumber(), startRule, 0, 0) });
 
+    bool stuck = false;
+    if (diagnostics)
+    {
+        diagnostics->furthestPosition = words.size();
+        diagnostics->expectedSymbols.clear();
+        diagnostics->cover.clear();
+        diagnostics->uncoveredWords.clear();
+    }
+
     // Perform parsing
     auto currentWord = words.begin();
     while (currentWord != words.end())
@@ -56,6 +82,19 @@ unsigned int Parser::parse(const std::vector<std::string> &words)
         scan(currentWord);
         complete();
 
+        // No edge could be advanced over this word
+        if (diagnostics && edges.back().empty())
+        {
+            if (!stuck)
+            {
+                stuck = true;
+                diagnostics->furthestPosition = edges.size() - 2;
+                findExpected(edges[edges.size() - 2], diagnostics->expectedSymbols);
+            }
+
+            recover(currentWord);
+        }
+
         ++currentWord;
     }
 
@@ -71,9 +110,119 @@ unsigned int Parser::parse(const std::vector<std::string> &words)
         // Regenerate parse trees, demonstrate ambiguity etc
     }
 
+    if (diagnostics)
+    {
+        // We ran out of words before completing a parse, so report what the sentence should have continued with
+        if (!stuck && completeParses.empty())
+            findExpected(edges.back(), diagnostics->expectedSymbols);
+
+        findCover(words.size(), *diagnostics);
+    }
+
     return completeParses.size();
 }
 
+void Parser::seed(const unsigned int position)
+{
+    // Predict every rule at this position, as if any nonterminal could start here
+    auto &gen = edges.at(position);
+    for (const auto &rs : rules)
+    {
+        for (const auto &r : rs.second)
+        {
+            bool alreadyExisted = !gen.insert(std::make_shared<Edge>(edgeNumber, r, position, position)).second;
+            if (!alreadyExisted)
+                ++edgeNumber;
+        }
+    }
+}
+void Parser::recover(const std::vector<std::string>::const_iterator currentWord)
+{
+    // Nothing could continue over the current word, so retry it as the start of a new constituent
+    edges.pop_back();
+    seed(edges.size() - 1);
+    predict();
+
+    edges.push_back({});
+    scan(currentWord);
+    complete();
+
+    // Nothing can start with this word either (eg. it isn't in any part of speech), so skip over it
+    if (edges.back().empty())
+        seed(edges.size() - 1);
+}
+void Parser::findExpected(const std::set<std::shared_ptr<Edge>, EdgePointerComparator> &gen,
+                          std::set<Symbol> &expected) const
+{
+    // Walk the predictions from this set through the rules instead of adding them to the chart,
+    // so the chart looks the same as it would after a plain parse
+    std::queue<Symbol> toExpand;
+    for (const auto &e : gen)
+    {
+        if (!e->completed() && expected.insert(e->nextSymbol()).second)
+            toExpand.push(e->nextSymbol());
+    }
+
+    while (!toExpand.empty())
+    {
+        const auto ruleIt = rules.find(toExpand.front());
+        toExpand.pop();
+        if (ruleIt == rules.end()) // No such rule
+            continue;
+
+        for (const auto &r : ruleIt->second)
+        {
+            if (!r.tail.empty() && expected.insert(r.tail.front()).second)
+                toExpand.push(r.tail.front());
+        }
+    }
+}
+void Parser::findCover(const std::size_t wordCount, ParseDiagnostics &diagnostics) const
+{
+    // best[i] is the cheapest way of covering the first i words as (fragments, uncovered words), where an
+    // uncovered word counts as a fragment of its own. via[i] is the constituent ending at i that gets there,
+    // or null if word i - 1 is left uncovered.
+    std::vector<std::pair<unsigned int, unsigned int>> best(wordCount + 1);
+    std::vector<std::shared_ptr<Edge>> via(wordCount + 1);
+
+    for (std::size_t end = 1; end <= wordCount; ++end)
+    {
+        best[end] = { best[end - 1].first + 1, best[end - 1].second + 1 };
+
+        // Every edge in a set ends at that set's position
+        for (const auto &e : edges[end])
+        {
+            if (!e->completed() || e->getStart() == e->getEnd())
+                continue;
+
+            const auto cost = std::make_pair(best[e->getStart()].first + 1, best[e->getStart()].second);
+            // An edge is always found after the edges it's built from, so on a tie take the edge found last
+            // to get the outermost constituent over the span (eg. P -> A over A -> a)
+            if (cost < best[end] ||
+                (cost == best[end] && via[end] && e->getEdgeNumber() > via[end]->getEdgeNumber()))
+            {
+                best[end] = cost;
+                via[end] = e;
+            }
+        }
+    }
+
+    // Walk back from the end of the sentence to recover the cover
+    std::size_t position = wordCount;
+    while (position > 0)
+    {
+        if (via[position])
+        {
+            diagnostics.cover.push_back(via[position]);
+            position = via[position]->getStart();
+        }
+        else
+            diagnostics.uncoveredWords.push_back(--position);
+    }
+    std::reverse(diagnostics.cover.begin(), diagnostics.cover.end());
+    std::reverse(diagnostics.uncoveredWords.begin(), diagnostics.uncoveredWords.end());
+}
+
 void Parser::predict()
 {
     auto &lastGen = edges.back();
@@ -189,52 +338,32 @@ void Parser::complete()
     }
 }
 
+void Parser::writeChart(ChartSink &sink) const
+{
+    for (std::size_t i = 0; i < edges.size(); ++i)
+    {
+        sink.beginWord(i, edges[i].size());
+        for (const auto &e : edges[i])
+            sink.addEdge(e->getEdgeNumber(), e->getRule(), e->getDot(), e->getStart(), e->getEnd(), e->getHistory());
+    }
+}
+void Parser::writeChart(std::ostream &out) const
+{
+    ChartWriter writer(out);
+    writeChart(writer);
+    writer.finish();
+}
+
 void Parser::printChart() const
 {
     printChart(std::cout);
 }
 void Parser::printChart(std::ostream &out) const
 {
-    std::vector<std::vector<EdgeString>> chart;
-
-    for (const auto &es : edges)
-    {
-        chart.push_back({});
-
-        // Sort the edges by edgeNumber
-        std::vector<std::shared_ptr<Edge>> sorted(es.begin(), es.end());
-        std::sort(sorted.begin(), sorted.end(),
-            [](const auto e1, const auto e2) { return e1->getEdgeNumber() < e2->getEdgeNumber(); });
-
-        for (const auto e : sorted)
-            chart.back().push_back(e->print());
-    }
+    // Build the chart directly rather than through the serialised form, it's rendered the same either way
+    Chart chart;
+    ChartBuilder builder(chart);
+    writeChart(builder);
 
-    std::size_t edgeNumberWidth = 0, ruleWidth = 0, spanWidth = 0, historyWidth = 0;
-    for (const auto &generation : chart)
-    {
-        for (const auto &edge : generation)
-        {
-            edgeNumberWidth = std::max(edgeNumberWidth, edge.edgeNumber.size());
-            ruleWidth = std::max(ruleWidth, edge.ruleProgress.size());
-            spanWidth = std::max(spanWidth, edge.span.size());
-            historyWidth = std::max(historyWidth, edge.history.size());
-        }
-    }
-
-    unsigned int wordCount = 0;
-    const std::string spacing = "    ";
-
-    out << std::left; // Left align output
-    for (const auto &generation : chart)
-    {
-        out << "Word " << wordCount++ << std::endl;
-        for (const auto &edge : generation)
-        {
-            out << std::setw(edgeNumberWidth) << edge.edgeNumber << spacing;
-            out << std::setw(ruleWidth) << edge.ruleProgress << spacing;
-            out << std::setw(spanWidth) << edge.span << spacing;
-            out << std::setw(historyWidth) << edge.history << std::endl;
-        }
-    }
-}
\ No newline at end of file
+    renderChart(out, chart);
+}
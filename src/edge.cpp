@@ -2,11 +2,6 @@
 
 #include <assert.h>
 
-std::ostream &operator <<(std::ostream &out, const EdgeString &e)
-{
-    return out << e.edgeNumber << " " << e.ruleProgress << " " << e.span << " " << e.history;
-}
-
 Edge::Edge(const unsigned int edgeNumber, const Rule r, const unsigned int start, const unsigned int end)
     : edgeNumber(edgeNumber), rule(r), start(start), end(end)
 {
@@ -31,6 +26,14 @@ Symbol Edge::getHead() const
 {
     return rule.head;
 }
+const Rule &Edge::getRule() const
+{
+    return rule;
+}
+std::size_t Edge::getDot() const
+{
+    return std::distance(rule.tail.begin(), rulePosition);
+}
 
 bool Edge::completed() const
 {
@@ -74,6 +77,10 @@ unsigned int Edge::getEdgeNumber() const
 {
     return edgeNumber;
 }
+const std::vector<std::shared_ptr<Edge>> &Edge::getHistory() const
+{
+    return history;
+}
 
 bool Edge::operator <(const Edge &rhs) const
 {
@@ -106,44 +113,4 @@ bool Edge::operator ==(const Edge &rhs) const
            start == rhs.start &&
            end == rhs.end &&
            history == rhs.history;
-}
-
-EdgeString Edge::print() const
-{
-    EdgeString out;
-    out.edgeNumber = "e" + std::to_string(edgeNumber);
-
-    out.ruleProgress = rule.head.getValue() + " ->";
-    // Output the tail symbols with a dot before the current symbol
-    for (auto i = rule.tail.begin(); i != rule.tail.end(); ++i)
-    {
-        if (rulePosition == i)
-            out.ruleProgress += " .";
-        out.ruleProgress += " " + i->getValue();
-    }
-    if (rulePosition == rule.tail.end())
-        out.ruleProgress += " .";
-
-    out.span = "(" + std::to_string(start) + "," + std::to_string(end) + ")";
-
-    if (history.empty())
-        out.history = "";
-    else
-    {
-        auto hi = history.begin(); // History iterator
-        auto ti = rule.tail.begin(); // Tail iterator
-        out.history = "(";
-        for (; ti != rule.tail.end(); ++ti)
-        {
-            if (ti->isNonterminal() && hi != history.end())
-            {
-                out.history += "e" + std::to_string((**hi).edgeNumber) + ","; // Dereference iterator then edge pointer
-                ++hi; // Move history iterator to the next nonterminal we completed
-            }
-        }
-        // Replace the trailing comma with a close bracket
-        out.history.back() = ')';
-    }
-
-    return out;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <fstream>
 
 #include "earley.h"
 
@@ -15,9 +16,37 @@ int main(int argc, char *argv[])
 
     p.printChart();
 
+    // Optionally keep a copy of the chart for chartinspect
+    if (argc > 1)
+    {
+        std::ofstream chartFile(argv[1], std::ios::binary);
+        p.writeChart(chartFile);
+    }
+
     std::cout << std::endl;
     std::cout << "Possible interpretations: " << interpretations << std::endl;
 
+    // Parse a broken sentence in recovery mode to see where it went wrong
+    const std::string brokenSentence = "they can fish quickly in in rivers";
+    ParseDiagnostics diagnostics;
+    p.parse(brokenSentence, diagnostics);
+
+    std::cout << std::endl;
+    std::cout << "\"" << brokenSentence << "\" got stuck after word " << diagnostics.furthestPosition << ", expected:";
+    for (const auto &s : diagnostics.expectedSymbols)
+        std::cout << " " << s.getValue();
+    std::cout << std::endl;
+
+    std::cout << "Partial parse:";
+    for (const auto &e : diagnostics.cover)
+        std::cout << " " << e->getHead().getValue() << "(" << e->getStart() << "," << e->getEnd() << ")";
+    std::cout << std::endl;
+
+    std::cout << "Uncovered words:";
+    for (const auto w : diagnostics.uncoveredWords)
+        std::cout << " " << w;
+    std::cout << std::endl;
+
     return 0;
 }
 
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <sstream>
+
+#include "earley.h"
+#include "chartio.h"
+
+unsigned int failures = 0;
+
+void check(const bool condition, const std::string &what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+Parser makeFishParser()
+{
+    Symbol S("S", SymbolType::Nonterminal);
+    Symbol NP("NP", SymbolType::Nonterminal);
+    Symbol VP("VP", SymbolType::Nonterminal);
+    Symbol PP("PP", SymbolType::Nonterminal);
+    Symbol N("N", SymbolType::Nonterminal);
+    Symbol V("V", SymbolType::Nonterminal);
+    Symbol P("P", SymbolType::Nonterminal);
+
+    std::vector<Rule> rules;
+    rules.emplace_back(S,  std::vector<Symbol> { NP, VP });
+    rules.emplace_back(NP, std::vector<Symbol> { N, PP });
+    rules.emplace_back(NP, std::vector<Symbol> { N });
+    rules.emplace_back(PP, std::vector<Symbol> { P, NP });
+    rules.emplace_back(VP, std::vector<Symbol> { VP, PP });
+    rules.emplace_back(VP, std::vector<Symbol> { V, VP });
+    rules.emplace_back(VP, std::vector<Symbol> { V, NP });
+    rules.emplace_back(VP, std::vector<Symbol> { V });
+
+    std::map<Symbol, std::set<std::string>> partsOfSpeech;
+    partsOfSpeech.emplace(N, std::set<std::string>{ "they", "can", "fish", "rivers" });
+    partsOfSpeech.emplace(P, std::set<std::string>{ "in" });
+    partsOfSpeech.emplace(V, std::set<std::string>{ "can", "fish" });
+
+    return Parser(S, rules, partsOfSpeech);
+}
+
+// Written charts read back in and render exactly as printChart does
+void checkRoundTrip()
+{
+    Parser p = makeFishParser();
+    check(p.parse("they can fish in rivers") == 4, "round trip: parse count");
+
+    std::stringstream printed, written, rendered;
+    p.printChart(printed);
+    p.writeChart(written);
+
+    const std::string serialised = written.str();
+
+    Chart chart;
+    check(readChart(written, chart), "round trip: readChart accepts a written chart");
+    renderChart(rendered, chart);
+    check(rendered.str() == printed.str(), "round trip: rendered chart matches printChart");
+
+    Chart empty;
+    check(diffCharts(std::cout, chart, chart) == 0, "round trip: chart doesn't differ from itself");
+
+    std::stringstream truncated(serialised.substr(0, serialised.size() - 1));
+    check(!readChart(truncated, empty), "round trip: truncated chart is rejected");
+}
+
+// Charts that only differ in how many ways an edge was derived still differ
+void checkDiffAmbiguity()
+{
+    Chart one, two;
+    for (Chart *c : { &one, &two })
+    {
+        c->symbols.emplace_back("S", SymbolType::Nonterminal);
+        c->symbols.emplace_back("A", SymbolType::Nonterminal);
+        c->symbols.emplace_back("B", SymbolType::Nonterminal);
+        c->words.resize(2);
+        // A(0,1) and B(0,1), either of which completes S
+        c->words[1].push_back({ 1, 1, {}, 0, 0, 1, {} });
+        c->words[1].push_back({ 2, 2, {}, 0, 0, 1, {} });
+        c->words[1].push_back({ 3, 0, { 1 }, 1, 0, 1, { 1 } });
+    }
+    two.words[1].push_back({ 4, 0, { 2 }, 1, 0, 1, { 2 } });
+
+    std::stringstream ignored;
+    check(diffCharts(ignored, one, two) == 1, "diff: extra derivation shows up");
+
+    // Same rule and span, but derived from a different edge
+    Chart other = one;
+    other.words[1][2].history = { 2 };
+    check(diffCharts(ignored, one, other) == 2, "diff: different derivation shows up");
+
+    // An exact duplicate still counts, even though the edges compare equal
+    Chart duplicated = one;
+    duplicated.words[1].push_back({ 5, 0, { 1 }, 1, 0, 1, { 1 } });
+    check(diffCharts(ignored, one, duplicated) == 1, "diff: duplicated edge shows up");
+
+    // Edge numbers alone don't make a difference
+    Chart renumbered = one;
+    renumbered.words[1][0].edgeNumber = 10;
+    renumbered.words[1][2].history = { 10 };
+    check(diffCharts(ignored, one, renumbered) == 0, "diff: renumbered edges are the same");
+}
+
+// S -> P Q R, where taking the longest constituent first (P -> A B) splits up the larger Q -> B C D
+Parser makeCoverParser()
+{
+    Symbol S("S", SymbolType::Nonterminal);
+    Symbol P("P", SymbolType::Nonterminal);
+    Symbol Q("Q", SymbolType::Nonterminal);
+    Symbol R("R", SymbolType::Nonterminal);
+    Symbol A("A", SymbolType::Nonterminal);
+    Symbol B("B", SymbolType::Nonterminal);
+    Symbol C("C", SymbolType::Nonterminal);
+    Symbol D("D", SymbolType::Nonterminal);
+
+    std::vector<Rule> rules;
+    rules.emplace_back(S, std::vector<Symbol> { P, Q, R });
+    rules.emplace_back(P, std::vector<Symbol> { A });
+    rules.emplace_back(P, std::vector<Symbol> { A, B });
+    rules.emplace_back(Q, std::vector<Symbol> { B, C, D });
+
+    std::map<Symbol, std::set<std::string>> partsOfSpeech;
+    partsOfSpeech.emplace(A, std::set<std::string>{ "a" });
+    partsOfSpeech.emplace(B, std::set<std::string>{ "b" });
+    partsOfSpeech.emplace(C, std::set<std::string>{ "c" });
+    partsOfSpeech.emplace(D, std::set<std::string>{ "d" });
+
+    return Parser(S, rules, partsOfSpeech);
+}
+
+std::string describeCover(const ParseDiagnostics &diagnostics)
+{
+    std::string out;
+    for (const auto &e : diagnostics.cover)
+    {
+        if (!out.empty())
+            out += " ";
+        out += e->getHead().getValue() + "(" + std::to_string(e->getStart()) + "," + std::to_string(e->getEnd()) + ")";
+    }
+    return out;
+}
+std::string describeExpected(const ParseDiagnostics &diagnostics)
+{
+    std::string out;
+    for (const auto &s : diagnostics.expectedSymbols)
+    {
+        if (!out.empty())
+            out += " ";
+        out += s.getValue();
+    }
+    return out;
+}
+
+void checkRecovery()
+{
+    check(ParseDiagnostics().furthestPosition == 0, "recovery: furthestPosition defaults to 0");
+
+    Parser p = makeFishParser();
+    ParseDiagnostics diagnostics;
+
+    // Stuck in the middle, with a word nothing can start with and one that only starts a new constituent
+    check(p.parse("they can fish quickly in in rivers", diagnostics) == 0, "recovery: broken sentence doesn't parse");
+    check(diagnostics.furthestPosition == 3, "recovery: stuck after the third word");
+    check(describeExpected(diagnostics) == "N NP P PP V VP", "recovery: expected symbols mid-sentence");
+    check(describeCover(diagnostics) == "S(0,3) P(4,5) PP(5,7)", "recovery: cover of broken sentence");
+    check(diagnostics.uncoveredWords == std::vector<unsigned int> { 3 }, "recovery: unknown word is uncovered");
+
+    // Running out of words, which mustn't leave anything extra in the chart
+    std::stringstream plainChart, diagnosedChart;
+    p.parse("they can fish in");
+    p.printChart(plainChart);
+    check(p.parse("they can fish in", diagnostics) == 0, "recovery: truncated sentence doesn't parse");
+    p.printChart(diagnosedChart);
+    check(diagnostics.furthestPosition == 4, "recovery: truncated sentence consumes every word");
+    check(describeExpected(diagnostics) == "N NP", "recovery: expected symbols at the end");
+    check(describeCover(diagnostics) == "S(0,3) P(3,4)", "recovery: cover of truncated sentence");
+    check(diagnosedChart.str() == plainChart.str(), "recovery: chart matches a plain parse");
+
+    // A good sentence is covered by one parse, and nothing's expected
+    check(p.parse("they can fish", diagnostics) == 2, "recovery: good sentence still parses");
+    check(diagnostics.furthestPosition == 3 && diagnostics.expectedSymbols.empty(), "recovery: good sentence never got stuck");
+    check(describeCover(diagnostics) == "S(0,3)" && diagnostics.uncoveredWords.empty(), "recovery: good sentence cover");
+
+    // Fewest fragments beats taking the longest constituent first
+    Parser coverParser = makeCoverParser();
+    check(coverParser.parse("a b c d", diagnostics) == 0, "cover: sentence doesn't parse");
+    check(describeCover(diagnostics) == "P(0,1) Q(1,4)", "cover: fewest fragments, outermost constituents");
+    check(diagnostics.uncoveredWords.empty(), "cover: every word covered");
+}
+
+int main()
+{
+    checkRoundTrip();
+    checkDiffAmbiguity();
+    checkRecovery();
+
+    if (failures == 0)
+        std::cout << "All checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
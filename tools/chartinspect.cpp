@@ -0,0 +1,108 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <limits>
+
+#include "chartio.h"
+
+// Offline viewer for charts written by Parser::writeChart
+//   chartinspect <chart> [--span start,end] [--symbol head]
+//   chartinspect --diff <before> <after>
+
+int usage()
+{
+    std::cerr << "Usage: chartinspect <chart> [--span start,end] [--symbol head]" << std::endl;
+    std::cerr << "       chartinspect --diff <before> <after>" << std::endl;
+    return 2;
+}
+
+bool loadChart(const std::string &path, Chart &chart)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        std::cerr << "Couldn't open " << path << std::endl;
+        return false;
+    }
+    if (!readChart(in, chart))
+    {
+        std::cerr << path << " isn't a valid chart" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+        return usage();
+
+    const std::string first = argv[1];
+    if (first == "--diff")
+    {
+        if (argc != 4)
+            return usage();
+
+        Chart before, after;
+        if (!loadChart(argv[2], before) || !loadChart(argv[3], after))
+            return 2;
+
+        return diffCharts(std::cout, before, after) == 0 ? 0 : 1;
+    }
+
+    bool filterSpan = false;
+    unsigned int spanStart = 0, spanEnd = 0;
+    bool filterSymbol = false;
+    std::string symbol;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--span" && i + 1 < argc)
+        {
+            const std::string span = argv[++i];
+            const auto comma = span.find(',');
+            if (comma == std::string::npos)
+                return usage();
+
+            unsigned long start, end;
+            try
+            {
+                start = std::stoul(span.substr(0, comma));
+                end = std::stoul(span.substr(comma + 1));
+            }
+            catch (const std::exception &)
+            {
+                return usage();
+            }
+            if (start > std::numeric_limits<unsigned int>::max() || end > std::numeric_limits<unsigned int>::max())
+                return usage();
+
+            spanStart = start;
+            spanEnd = end;
+            filterSpan = true;
+        }
+        else if (arg == "--symbol" && i + 1 < argc)
+        {
+            symbol = argv[++i];
+            filterSymbol = true;
+        }
+        else
+            return usage();
+    }
+
+    Chart chart;
+    if (!loadChart(first, chart))
+        return 2;
+
+    renderChart(std::cout, chart, [&](const ChartEdge &e)
+    {
+        if (filterSpan && (e.start != spanStart || e.end != spanEnd))
+            return false;
+        if (filterSymbol && chart.symbols[e.head].getValue() != symbol)
+            return false;
+        return true;
+    });
+
+    return 0;
+}